@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <string.h>
+#include "policy.h"
+
+static long nextQueueSeq = 0;
+
+// Function to compute the longest chain of queued jobs hanging off jobId
+static int criticalPathLength(struct Process *queue, int count, int jobId, int *memo) {
+    if (memo[JOB_SLOT(jobId)] > 0) return memo[JOB_SLOT(jobId)];
+
+    int longest = 0;
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < queue[i].parentCount; j++) {
+            if (queue[i].parents[j] == jobId) {
+                int length = criticalPathLength(queue, count, queue[i].jobId, memo);
+                if (length > longest) longest = length;
+                break;
+            }
+        }
+    }
+    memo[JOB_SLOT(jobId)] = longest + 1;
+    return memo[JOB_SLOT(jobId)];
+}
+
+// Ready means no unfinished parents, not held back by admission control
+// and not throttled under memory pressure
+static bool isReady(const struct Process *process) {
+    return process->pendingParents == 0 && !process->heldBack && !process->throttled;
+}
+
+// Stamp the job so equal candidates are served in arrival order
+static void stampEnqueue(struct Process *process) {
+    process->queueSeq = nextQueueSeq++;
+}
+
+static bool alwaysPreempt(struct Process *process) {
+    return true;
+}
+
+static bool neverPreempt(struct Process *process) {
+    return false;
+}
+
+static void ignoreExit(struct Process *process, bool succeeded) {
+}
+
+// Highest priority first, then the oldest
+static bool priorityRunsBefore(const struct Process *a, const struct Process *b) {
+    if (a->priority != b->priority) return a->priority < b->priority;
+    return a->queueSeq < b->queueSeq;
+}
+
+// Oldest first, ignoring priority
+static bool fifoRunsBefore(const struct Process *a, const struct Process *b) {
+    return a->queueSeq < b->queueSeq;
+}
+
+// Function to pick the index of the job to run next, or -1 if none is ready.
+// With criticalPathFirst, the ready job heading the longest chain of waiting
+// dependents wins; runsBefore decides among equals (and alone otherwise).
+int pickNext(const struct SchedPolicy *policy, struct Process *queue, int count) {
+    static int memo[MAX_JOBS];
+    bool hasDependencies = false;
+    int bestIndex = -1;
+    int bestPath = 0;
+
+    for (int i = 0; policy->criticalPathFirst && i < count; i++) {
+        if (queue[i].parentCount > 0) {
+            hasDependencies = true;
+            break;
+        }
+    }
+    if (hasDependencies) memset(memo, 0, sizeof(memo));
+
+    for (int i = 0; i < count; i++) {
+        if (!isReady(&queue[i])) continue;
+
+        int path = 1;
+        if (hasDependencies) {
+            path = criticalPathLength(queue, count, queue[i].jobId, memo);
+        }
+        if (bestIndex == -1 || path > bestPath ||
+            (path == bestPath && policy->runsBefore(&queue[i], &queue[bestIndex]))) {
+            bestIndex = i;
+            bestPath = path;
+        }
+    }
+    return bestIndex;
+}
+
+static const struct SchedPolicy policies[] = {
+    { "priority", true,  priorityRunsBefore, stampEnqueue, alwaysPreempt, ignoreExit },
+    { "rr",       false, fifoRunsBefore,     stampEnqueue, alwaysPreempt, ignoreExit },
+    { "fcfs",     false, fifoRunsBefore,     stampEnqueue, neverPreempt,  ignoreExit },
+};
+
+// Function to look up a policy by name, NULL if unknown
+const struct SchedPolicy *findPolicy(const char *name) {
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        if (strcmp(policies[i].name, name) == 0) return &policies[i];
+    }
+    return NULL;
+}
+
+void printPolicyNames() {
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        fprintf(stderr, "%s%s", i == 0 ? "" : ", ", policies[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+long timevalToMs(struct timeval tv) {
+    return tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// Function to print turnaround, wait and fairness over every job that ran.
+// Fairness is Jain's index over run time / turnaround (1.0 = perfectly even).
+void printScheduleSummary(const struct Process *completed, int count) {
+    int jobs = 0;
+    double totalTurnaround = 0, totalWait = 0;
+    double shareSum = 0, shareSquareSum = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (completed[i].pid == -1) continue;  // Skipped, never ran
+
+        long turnaround = timevalToMs(completed[i].endTime) - timevalToMs(completed[i].startTime);
+        double share = turnaround > 0 ? (double)completed[i].runTime / turnaround : 1.0;
+        if (share > 1.0) share = 1.0;
+
+        totalTurnaround += turnaround;
+        totalWait += completed[i].waitTime;
+        shareSum += share;
+        shareSquareSum += share * share;
+        jobs++;
+    }
+
+    printf("\n---- Schedule Summary ----\n");
+    printf("Jobs: %d\n", jobs);
+    if (jobs == 0) return;
+    printf("Average Turnaround Time: %.2f ms\n", totalTurnaround / jobs);
+    printf("Average Wait Time: %.2f ms\n", totalWait / jobs);
+    printf("Fairness (Jain's index): %.3f\n", shareSquareSum > 0 ? (shareSum * shareSum) / (jobs * shareSquareSum) : 1.0);
+}
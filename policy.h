@@ -0,0 +1,69 @@
+// policy.h
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include "shared_memory.h"
+
+#define MAX_JOBS 1024
+#define MAX_DEPENDENCIES 16
+
+// Job IDs keep growing; per-job tables are indexed by JOB_SLOT instead, which
+// is unique among jobs in flight as long as fewer than MAX_JOBS IDs separate them
+#define JOB_SLOT(jobId) ((jobId) % MAX_JOBS)
+
+// Lifecycle of a job, indexed by JOB_SLOT(jobId) in jobState[]
+enum JobState {
+    JOB_UNKNOWN = 0,
+    JOB_PENDING,
+    JOB_RUNNING,
+    JOB_DONE,
+    JOB_FAILED,
+    JOB_SKIPPED
+};
+
+struct Process {
+    char executableName[256];
+    int priority;
+    pid_t pid;
+    bool isRunning;
+    struct timeval startTime;          // Arrival time
+    struct timeval endTime;
+    long waitTime;                     // Time spent not running, in ms
+    int jobId;                         // 0 means "no job"
+    int parents[MAX_DEPENDENCIES];     // Jobs that must exit successfully first
+    int parentCount;
+    int pendingParents;                // In-degree: parents that have not finished yet
+    struct timeval dispatchTime;       // When the current quantum started
+    long runTime;                      // Time spent running, in ms
+    long queueSeq;                     // Order of the latest enqueue, for FIFO tie-breaks
+    long peakRss;                      // Peak resident set size in KB, from rusage
+    enum JobState state;               // Final state, set once the job is recorded as completed
+    bool heldBack;                     // Admission control is holding this job back
+    int heldTicks;                     // Ticks spent held back by admission control
+    bool throttled;                    // Stopped under memory pressure until the limit recovers
+};
+
+// Scheduling policy hooks, shared by the live scheduler and schedsim.
+// runsBefore is the only ordering hook, so both replay the same decisions:
+// the scheduler picks with pickNext() below, and schedsim keeps its ready jobs
+// in a heap ordered by runsBefore. Trace jobs have no dependencies, so there
+// the critical-path step of pickNext() never changes the pick.
+struct SchedPolicy {
+    const char *name;
+    bool criticalPathFirst;                                    // Prefer the ready job heading the longest chain of dependents
+    bool (*runsBefore)(const struct Process *a, const struct Process *b);  // Strict order among ready jobs
+    void (*onEnqueue)(struct Process *process);                // Job joined (or rejoined) the ready queue
+    bool (*onQuantumExpire)(struct Process *process);          // Return true if the job may be preempted
+    void (*onExit)(struct Process *process, bool succeeded);   // Job finished
+};
+
+int pickNext(const struct SchedPolicy *policy, struct Process *queue, int count);  // Index of the job to run next, or -1
+const struct SchedPolicy *findPolicy(const char *name);
+void printPolicyNames();
+long timevalToMs(struct timeval tv);
+void printScheduleSummary(const struct Process *completed, int count);
+
+#endif // POLICY_H
@@ -0,0 +1,393 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
+#include "policy.h"
+
+#define MAX_CPUS 64
+
+// Synthetic traces: default mean gap between arrivals and mean burst, in ms
+#define SYNTHETIC_MEAN_ARRIVAL 100
+#define SYNTHETIC_MEAN_BURST 200
+
+// Trace jobs, sorted by arrival. jobs[i] has jobId i + 1.
+struct Process *jobs;
+long *arrival;
+long *remaining;  // Burst left to run, in ms
+long jobCount = 0;
+long jobCapacity = 0;
+
+// Simulator state, in virtual milliseconds. The ready queue is a binary heap
+// of job indices ordered by the policy's runsBefore, so picks are O(log n)
+// however far the queue backs up. Trace jobs have no dependencies, so the heap
+// top is what pickNext() would choose in the live scheduler.
+int *readyHeap;
+int readyCount = 0;
+int running[MAX_CPUS];  // Job index per CPU, -1 when free
+long completedCount = 0;
+long makespan = 0;
+const struct SchedPolicy *policy;
+int ncpu, tslice;
+bool verbose = false;
+
+// Function prototypes
+void addJob(const char *name, long arrivalMs, long burstMs, int priority);
+int loadTrace(FILE *file);
+void generateTrace(long count, unsigned int seed, double meanArrival, double meanBurst);
+void sortTrace();
+struct timeval msToTimeval(long ms);
+void heapPush(int job);
+int heapPop();
+void dispatch(int slot, long now);
+long simulate();
+
+// Function to append a job to the trace
+void addJob(const char *name, long arrivalMs, long burstMs, int priority) {
+    if (jobCount == jobCapacity) {
+        jobCapacity = jobCapacity == 0 ? 1024 : jobCapacity * 2;
+        jobs = realloc(jobs, jobCapacity * sizeof(struct Process));
+        arrival = realloc(arrival, jobCapacity * sizeof(long));
+        remaining = realloc(remaining, jobCapacity * sizeof(long));
+        if (!jobs || !arrival || !remaining) {
+            fprintf(stderr, "error: memory allocation failed\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    struct Process *process = &jobs[jobCount];
+    memset(process, 0, sizeof(*process));
+    strncpy(process->executableName, name, sizeof(process->executableName) - 1);
+    process->priority = priority;
+    process->pid = -1;
+    arrival[jobCount] = arrivalMs;
+    remaining[jobCount] = burstMs;
+    jobCount++;
+}
+
+// Function to read "<name> <arrival_ms> <burst_ms> [priority]" lines
+int loadTrace(FILE *file) {
+    char line[1024];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lineNumber++;
+        char *start = line + strspn(line, " \t");
+        if (*start == '\n' || *start == '\0' || *start == '#') continue;
+
+        char name[256];
+        long arrivalMs, burstMs;
+        int priority = 1;
+        if (sscanf(start, "%255s %ld %ld %d", name, &arrivalMs, &burstMs, &priority) < 3 ||
+            arrivalMs < 0 || burstMs <= 0) {
+            fprintf(stderr, "Malformed trace line %d: %s", lineNumber, line);
+            return -1;
+        }
+        addJob(name, arrivalMs, burstMs, priority);
+    }
+    return 0;
+}
+
+// Function to build a trace with exponential arrival gaps and bursts
+void generateTrace(long count, unsigned int seed, double meanArrival, double meanBurst) {
+    char name[32];
+    long now = 0;
+    srand(seed);
+    for (long i = 0; i < count; i++) {
+        double gap = -log(1.0 - rand() / (RAND_MAX + 1.0)) * meanArrival;
+        double burst = -log(1.0 - rand() / (RAND_MAX + 1.0)) * meanBurst;
+        now += (long)gap;
+        snprintf(name, sizeof(name), "job%ld", i + 1);
+        addJob(name, now, burst >= 1 ? (long)burst : 1, 1 + rand() % 4);
+    }
+}
+
+// Order trace indices by arrival, keeping file order for ties
+static int compareArrival(const void *a, const void *b) {
+    long left = *(const long *)a, right = *(const long *)b;
+    if (arrival[left] != arrival[right]) return arrival[left] < arrival[right] ? -1 : 1;
+    return left < right ? -1 : (left > right);
+}
+
+// Function to sort the trace by arrival and number the jobs
+void sortTrace() {
+    long *order = malloc(jobCount * sizeof(long));
+    struct Process *sortedJobs = malloc(jobCount * sizeof(struct Process));
+    long *sortedArrival = malloc(jobCount * sizeof(long));
+    long *sortedRemaining = malloc(jobCount * sizeof(long));
+    if (!order || !sortedJobs || !sortedArrival || !sortedRemaining) {
+        fprintf(stderr, "error: memory allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (long i = 0; i < jobCount; i++) order[i] = i;
+    qsort(order, jobCount, sizeof(long), compareArrival);
+    for (long i = 0; i < jobCount; i++) {
+        sortedJobs[i] = jobs[order[i]];
+        sortedArrival[i] = arrival[order[i]];
+        sortedRemaining[i] = remaining[order[i]];
+        sortedJobs[i].jobId = i + 1;
+        sortedJobs[i].startTime = msToTimeval(sortedArrival[i]);
+    }
+
+    free(order);
+    free(jobs);
+    free(arrival);
+    free(remaining);
+    jobs = sortedJobs;
+    arrival = sortedArrival;
+    remaining = sortedRemaining;
+}
+
+struct timeval msToTimeval(long ms) {
+    struct timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    return tv;
+}
+
+// Function to add a job index to the ready heap
+void heapPush(int job) {
+    int child = readyCount++;
+    while (child > 0) {
+        int parent = (child - 1) / 2;
+        if (!policy->runsBefore(&jobs[job], &jobs[readyHeap[parent]])) break;
+        readyHeap[child] = readyHeap[parent];
+        child = parent;
+    }
+    readyHeap[child] = job;
+}
+
+// Function to remove and return the job the policy runs next
+int heapPop() {
+    int top = readyHeap[0];
+    int last = readyHeap[--readyCount];
+    int parent = 0;
+    while (true) {
+        int child = 2 * parent + 1;
+        if (child >= readyCount) break;
+        if (child + 1 < readyCount && policy->runsBefore(&jobs[readyHeap[child + 1]], &jobs[readyHeap[child]])) {
+            child++;
+        }
+        if (!policy->runsBefore(&jobs[readyHeap[child]], &jobs[last])) break;
+        readyHeap[parent] = readyHeap[child];
+        parent = child;
+    }
+    readyHeap[parent] = last;
+    return top;
+}
+
+// Function to fill a free CPU slot with the next job picked by the policy
+void dispatch(int slot, long now) {
+    if (readyCount == 0) return;
+
+    int job = heapPop();
+    running[slot] = job;
+    jobs[job].isRunning = true;
+    jobs[job].pid = jobs[job].jobId;  // No real process, but marks the job as having run
+    jobs[job].dispatchTime = msToTimeval(now);
+}
+
+// Function to replay the trace in virtual time, mirroring the live scheduler:
+// arrivals wait for the next tick; each tick fills idle CPUs, then preempts an
+// expired job only if the head of the ready queue would run before it; a CPU
+// freed by an exit is refilled immediately. Returns the event count.
+long simulate() {
+    long now = 0;
+    long nextTick = tslice;
+    long nextArrival = 0;
+    long events = 0;
+
+    for (int i = 0; i < ncpu; i++) running[i] = -1;
+
+    while (completedCount < jobCount) {
+        bool anyRunning = false;
+        for (int i = 0; i < ncpu; i++) {
+            if (running[i] != -1) anyRunning = true;
+        }
+
+        // Idle CPUs and nothing ready: skip straight to the next arrival
+        if (!anyRunning && readyCount == 0 && nextArrival < jobCount && arrival[nextArrival] > now) {
+            now = arrival[nextArrival];
+            nextTick = ((now + tslice - 1) / tslice) * tslice;
+        }
+
+        // The next event is either the tick or the earliest exit before it
+        long eventTime = nextTick;
+        int exitSlot = -1;
+        for (int i = 0; i < ncpu; i++) {
+            if (running[i] == -1) continue;
+            long finish = timevalToMs(jobs[running[i]].dispatchTime) + remaining[running[i]];
+            if (finish <= eventTime) {
+                eventTime = finish;
+                exitSlot = i;
+            }
+        }
+
+        while (nextArrival < jobCount && arrival[nextArrival] <= eventTime) {
+            policy->onEnqueue(&jobs[nextArrival]);
+            heapPush(nextArrival++);
+        }
+        now = eventTime;
+        events++;
+
+        if (exitSlot >= 0) {
+            struct Process *process = &jobs[running[exitSlot]];
+            running[exitSlot] = -1;
+
+            process->runTime += now - timevalToMs(process->dispatchTime);
+            remaining[process->jobId - 1] = 0;
+            process->endTime = msToTimeval(now);
+            process->waitTime = (now - timevalToMs(process->startTime)) - process->runTime;
+            process->isRunning = false;
+            policy->onExit(process, true);
+            completedCount++;
+            makespan = now;
+            if (verbose) {
+                printf("%ld ms: %s (Job ID: %d) completed, Wait Time: %ld ms\n",
+                       now, process->executableName, process->jobId, process->waitTime);
+            }
+
+            dispatch(exitSlot, now);
+            continue;
+        }
+
+        bool expired[MAX_CPUS] = {false};
+        struct Process requeued[MAX_CPUS];
+        for (int i = 0; i < ncpu; i++) {
+            if (running[i] == -1) {
+                dispatch(i, now);
+                continue;
+            }
+
+            struct Process *process = &jobs[running[i]];
+            long ran = now - timevalToMs(process->dispatchTime);
+            process->runTime += ran;
+            remaining[running[i]] -= ran;
+            process->dispatchTime = msToTimeval(now);
+            if (!policy->onQuantumExpire(process)) continue;
+
+            // Ranked as if requeued, which is what preemption would do
+            expired[i] = true;
+            requeued[i] = *process;
+            policy->onEnqueue(&requeued[i]);
+        }
+
+        // Swap out the weakest expired job while the queue head beats it
+        while (readyCount > 0) {
+            int weakest = -1;
+            for (int i = 0; i < ncpu; i++) {
+                if (expired[i] && (weakest == -1 || policy->runsBefore(&requeued[weakest], &requeued[i]))) {
+                    weakest = i;
+                }
+            }
+            if (weakest == -1 || !policy->runsBefore(&jobs[readyHeap[0]], &requeued[weakest])) break;
+
+            int job = running[weakest];
+            jobs[job] = requeued[weakest];
+            jobs[job].isRunning = false;
+            expired[weakest] = false;
+            dispatch(weakest, now);
+            heapPush(job);
+        }
+        nextTick += tslice;
+    }
+    return events;
+}
+
+int main(int argc, char *argv[]) {
+    const char *policyName = "priority";
+    long syntheticJobs = 0;
+    unsigned int seed = 1;
+    double meanArrival = SYNTHETIC_MEAN_ARRIVAL;
+    double meanBurst = SYNTHETIC_MEAN_BURST;
+    double utilisation = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:n:s:a:b:u:v")) != -1) {
+        switch (opt) {
+            case 'p': policyName = optarg; break;
+            case 'n': syntheticJobs = atol(optarg); break;
+            case 's': seed = (unsigned int)atoi(optarg); break;
+            case 'a': meanArrival = atof(optarg); break;
+            case 'b': meanBurst = atof(optarg); break;
+            case 'u': utilisation = atof(optarg); break;
+            case 'v': verbose = true; break;
+            default:
+                fprintf(stderr, "Usage: %s [-p policy] [-n jobs] [-s seed] [-a mean_arrival_ms] [-b mean_burst_ms] [-u utilisation] [-v] <NCPU> <TSLICE> [trace]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (argc - optind < 2 || argc - optind > 3) {
+        fprintf(stderr, "Usage: %s [-p policy] [-n jobs] [-s seed] [-a mean_arrival_ms] [-b mean_burst_ms] [-u utilisation] [-v] <NCPU> <TSLICE> [trace]\n", argv[0]);
+        return 1;
+    }
+
+    ncpu = atoi(argv[optind]);
+    tslice = atoi(argv[optind + 1]);
+    if (ncpu < 1 || ncpu > MAX_CPUS || tslice < 1) {
+        fprintf(stderr, "NCPU must be between 1 and %d and TSLICE at least 1 ms\n", MAX_CPUS);
+        return 1;
+    }
+    policy = findPolicy(policyName);
+    if (policy == NULL) {
+        fprintf(stderr, "Unknown policy %s. Available: ", policyName);
+        printPolicyNames();
+        return 1;
+    }
+
+    if (syntheticJobs > 0) {
+        // -u sets the offered load as a fraction of NCPU, overriding -a
+        if (utilisation > 0) meanArrival = meanBurst / (ncpu * utilisation);
+        if (meanArrival <= 0 || meanBurst <= 0) {
+            fprintf(stderr, "Mean arrival gap and burst must be positive\n");
+            return 1;
+        }
+        generateTrace(syntheticJobs, seed, meanArrival, meanBurst);
+    } else {
+        FILE *file = stdin;
+        if (argc - optind == 3) {
+            file = fopen(argv[optind + 2], "r");
+            if (file == NULL) {
+                perror("fopen");
+                return 1;
+            }
+        }
+        int result = loadTrace(file);
+        if (file != stdin) fclose(file);
+        if (result != 0) return 1;
+    }
+    if (jobCount == 0) {
+        fprintf(stderr, "Trace is empty\n");
+        return 1;
+    }
+    if (jobCount >= INT_MAX) {
+        fprintf(stderr, "Trace is too large\n");
+        return 1;
+    }
+    sortTrace();
+
+    readyHeap = malloc(jobCount * sizeof(int));
+    if (!readyHeap) {
+        fprintf(stderr, "error: memory allocation failed\n");
+        return 1;
+    }
+
+    printf("Starting schedsim with %d CPU cores and a time slice of %d milliseconds (policy: %s, %ld jobs).\n",
+           ncpu, tslice, policy->name, jobCount);
+
+    clock_t begin = clock();
+    long events = simulate();
+    double elapsed = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    printScheduleSummary(jobs, (int)jobCount);
+    printf("Makespan: %ld ms\n", makespan);
+    printf("Simulated %ld events in %.3f s (%.0f events/s)\n", events, elapsed, elapsed > 0 ? events / elapsed : 0.0);
+
+    free(jobs);
+    free(arrival);
+    free(remaining);
+    free(readyHeap);
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/resource.h>
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <stdbool.h>
@@ -11,30 +12,64 @@
 #include <time.h>
 #include <sys/time.h>
 #include "shared_memory.h"
+#include "policy.h"
 
 
 #define MAX_PROCESSES 256
+#define MAX_CPUS 64
 
-struct Process {
-    char executableName[256];
-    int priority;
-    pid_t pid;
-    bool isRunning;
-    struct timeval startTime;
-    struct timeval endTime;
-    long waitTime;
-};
+// Memory admission control. Sizes are in KB, as reported by rusage and /proc/meminfo.
+#ifndef MEMORY_RESERVE_KB
+#define MEMORY_RESERVE_KB (256 * 1024)   // Headroom left for everything else on the box
+#endif
+#ifndef MEMORY_PRESSURE_THRESHOLD
+#define MEMORY_PRESSURE_THRESHOLD 10.0   // Percentage of time stalled on memory (PSI "some") that triggers throttling
+#endif
+#ifndef MEMORY_RECOVER_THRESHOLD
+#define MEMORY_RECOVER_THRESHOLD 2.0     // Stall percentage below which the limit may grow back
+#endif
+#ifndef MEMORY_PRESSURE_WINDOW_MS
+#define MEMORY_PRESSURE_WINDOW_MS 1000   // Pressure is measured over, and the limit changed at most once per, this window
+#endif
+#ifndef MEMORY_HOLD_TICKS
+#define MEMORY_HOLD_TICKS 10             // Ticks a job can be held back before nothing new is admitted ahead of it
+#endif
 
 // Shared memory structure
 
 
 // Process queue and count
 struct Process queue[MAX_PROCESSES];
-struct Process completedQueue[MAX_PROCESSES];
+struct Process completedQueue[MAX_JOBS];
+struct Process running[MAX_CPUS];  // One slot per CPU, jobId 0 when free
 int queueCount = 0;
 int completedQueueCount = 0;
+int unreportedCount = 0;          // Jobs that finished after completedQueue filled up
+
+// Job bookkeeping for dependency tracking. Slots are recycled (see JOB_SLOT),
+// so MAX_JOBS bounds the jobs in flight, not the jobs ever submitted.
+enum JobState jobState[MAX_JOBS];
+int jobSlotOwner[MAX_JOBS];       // Job ID whose state each slot currently holds
+int nextJobId = 1;
+
+// Observed peak RSS per executable, used to predict a job's footprint
+struct MemoryEstimate {
+    char executableName[256];
+    long peakRss;
+};
+struct MemoryEstimate memoryEstimates[MAX_PROCESSES];
+int memoryEstimateCount = 0;
+
+int memorySlots;                  // CPU slots usable under the current memory pressure
+long availableMemory = -1;        // Latest MemAvailable, -1 if /proc/meminfo is unreadable
+long pageSizeKb;
+long lowestAvailableMemory = -1;
+bool everHeldBack[MAX_JOBS];      // Report and count each held job once, by JOB_SLOT
+int admissionHolds = 0;
+int throttleStops = 0;
 
 int ncpu, tslice;
+const struct SchedPolicy *policy;
 pid_t scheduler_pid;
 bool executionStarted = false;  // To track if SIGINT has been received
 
@@ -45,50 +80,229 @@ void sigchldHandler(int sig);
 void printProcessCompletionDetails();
 void init_shared_memory(SharedMemoryData **sharedData);
 void print_shared_memory(SharedMemoryData *sharedData);
-void enqueue(SharedMemoryData *sharedData, const char* name, int priority);
+int enqueue(SharedMemoryData *sharedData, const char* name, int priority, const int *parents, int parentCount);
 struct Process dequeue();
+enum JobState getJobState(int jobId);
+void setJobState(int jobId, enum JobState state);
+bool jobSlotFree(int jobId);
+void recordCompletion(struct Process process, enum JobState state);
+void releaseDependents(int jobId);
+void skipDependents(int jobId);
+int runningCount();
+bool dispatch(int slot);
+void fillFreeSlots();
+void preemptExpired();
+void requeueRunning(int slot);
+void throttleForMemory();
+void releaseThrottled();
+bool admitProcess(const struct Process *process);
+long expectedGrowth(const struct Process *process);
+long predictedFootprint(const char *name);
+void recordPeakRss(const char *name, long peakRss);
+void refreshAvailableMemory();
+ssize_t readProcFile(const char *path, char *buf, size_t size);
+long parseProcField(const char *text, const char *key);
+long readAvailableMemory();
+long readMemoryStallTotal();
+long readCurrentRss(pid_t pid);
+void printMemoryStats();
+void startProcess(struct Process *process);
+void finishProcess(struct Process process, int status);
+void writeTrace(const char *path);
+int parseSubmitLine(char *line, char *name, int *priority, int *parents, int *parentCount);
+void submitDagFile(SharedMemoryData *sharedData, const char *path);
 
-// Function to add process to queue
-void enqueue(SharedMemoryData *sharedData, const char* name, int priority) {
-    if (queueCount < MAX_PROCESSES) {
-        for (int i = 0; i < queueCount; i++) {
-            if (strcmp(queue[i].executableName, name) == 0) {
-                printf("Duplicate entry: %s\n", name);
-                return;
-            }
+// Function to add process to queue. Returns the new job ID, or 0 if rejected.
+int enqueue(SharedMemoryData *sharedData, const char* name, int priority, const int *parents, int parentCount) {
+    if (queueCount + runningCount() >= MAX_PROCESSES) {
+        printf("Queue is full. Cannot add more entries.\n");
+        return 0;
+    }
+    if (!jobSlotFree(nextJobId)) {
+        printf("Too many jobs in flight: job %d has not finished and job slots are reused every %d jobs. Cannot add %s.\n",
+               nextJobId - MAX_JOBS, MAX_JOBS, name);
+        return 0;
+    }
+    for (int i = 0; i < parentCount; i++) {
+        if (parents[i] < 1 || parents[i] >= nextJobId) {
+            printf("Unknown dependency %d for %s\n", parents[i], name);
+            return 0;
+        }
+        if (getJobState(parents[i]) == JOB_UNKNOWN) {
+            printf("Dependency %d for %s is too old to track (only the last %d jobs are kept)\n",
+                   parents[i], name, MAX_JOBS);
+            return 0;
         }
+    }
 
-        strncpy(queue[queueCount].executableName, name, sizeof(queue[queueCount].executableName) - 1);
-        queue[queueCount].priority = priority;
-        queue[queueCount].pid = -1;
-        queue[queueCount].isRunning = false;
-        queue[queueCount].waitTime = 0;
-        printf("Process added to queue: %s with priority %d\n", name, priority);
-        queueCount++;
-        print_shared_memory(sharedData);
-    } else {
-        printf("Queue is full. Cannot add more entries.\n");
+    struct Process process = {0};
+    strncpy(process.executableName, name, sizeof(process.executableName) - 1);
+    process.priority = priority;
+    process.pid = -1;
+    process.isRunning = false;
+    process.waitTime = 0;
+    gettimeofday(&process.startTime, NULL);  // Arrival time, used for wait and completion time
+    process.jobId = nextJobId++;
+    process.parentCount = parentCount;
+
+    bool parentFailed = false;
+    for (int i = 0; i < parentCount; i++) {
+        process.parents[i] = parents[i];
+        enum JobState parentState = getJobState(parents[i]);
+        if (parentState == JOB_FAILED || parentState == JOB_SKIPPED) {
+            parentFailed = true;
+        } else if (parentState != JOB_DONE) {
+            process.pendingParents++;
+        }
+    }
+
+    // A parent already failed, so this job can never run
+    if (parentFailed) {
+        recordCompletion(process, JOB_SKIPPED);
+        printf("Job %d (%s) skipped: a dependency has already failed\n", process.jobId, name);
+        return process.jobId;
     }
+
+    setJobState(process.jobId, JOB_PENDING);
+    everHeldBack[JOB_SLOT(process.jobId)] = false;
+    policy->onEnqueue(&process);
+    queue[queueCount++] = process;
+    printf("Process added to queue: %s with priority %d (Job ID: %d, waiting on %d)\n",
+           name, priority, process.jobId, process.pendingParents);
+    print_shared_memory(sharedData);
+    return process.jobId;
 }
 
-// Function to dequeue process with highest priority
+// Function to dequeue the process chosen by the active policy, skipping
+// new jobs that admission control says do not fit in memory
 struct Process dequeue() {
-    if (queueCount > 0) {
-        int highestPriorityIndex = 0;
-        for (int i = 1; i < queueCount; i++) {
-            if (queue[i].priority < queue[highestPriorityIndex].priority) {
-                highestPriorityIndex = i;
+    int index;
+    while ((index = pickNext(policy, queue, queueCount)) >= 0) {
+        if (queue[index].pid != -1 || admitProcess(&queue[index])) break;
+        queue[index].heldBack = true;
+    }
+    if (index < 0) return (struct Process){ .jobId = 0, .pid = -1 };
+
+    struct Process result = queue[index];
+    for (int i = index; i < queueCount - 1; i++) {
+        queue[i] = queue[i + 1];
+    }
+    queueCount--;
+    printf("Dequeued process: %s (Job ID: %d)\n", result.executableName, result.jobId);
+    return result;
+}
+
+// Function to count busy CPU slots
+int runningCount() {
+    int count = 0;
+    for (int i = 0; i < ncpu; i++) {
+        if (running[i].jobId != 0) count++;
+    }
+    return count;
+}
+
+// Function to look up a job's state, JOB_UNKNOWN once its slot was recycled
+enum JobState getJobState(int jobId) {
+    return jobSlotOwner[JOB_SLOT(jobId)] == jobId ? jobState[JOB_SLOT(jobId)] : JOB_UNKNOWN;
+}
+
+void setJobState(int jobId, enum JobState state) {
+    jobSlotOwner[JOB_SLOT(jobId)] = jobId;
+    jobState[JOB_SLOT(jobId)] = state;
+}
+
+// Function to check that jobId's slot is not held by a job still in flight
+bool jobSlotFree(int jobId) {
+    enum JobState state = getJobState(jobSlotOwner[JOB_SLOT(jobId)]);
+    return state != JOB_PENDING && state != JOB_RUNNING;
+}
+
+// Function to settle a finished (or skipped) job's state and store it for the final report
+void recordCompletion(struct Process process, enum JobState state) {
+    setJobState(process.jobId, state);
+    process.state = state;
+    if (completedQueueCount < MAX_JOBS) {
+        completedQueue[completedQueueCount++] = process;
+    } else {
+        unreportedCount++;
+    }
+}
+
+// Function to decrement the in-degree of every job waiting on jobId
+void releaseDependents(int jobId) {
+    for (int i = 0; i < queueCount; i++) {
+        for (int j = 0; j < queue[i].parentCount; j++) {
+            if (queue[i].parents[j] == jobId) {
+                queue[i].pendingParents--;
+                if (queue[i].pendingParents == 0) {
+                    printf("Job %d (%s) released: all dependencies finished\n",
+                           queue[i].jobId, queue[i].executableName);
+                }
+                break;
+            }
+        }
+    }
+}
+
+// Function to drop the whole subtree of a failed job from the queue
+void skipDependents(int jobId) {
+    int i = 0;
+    while (i < queueCount) {
+        bool isChild = false;
+        for (int j = 0; j < queue[i].parentCount; j++) {
+            if (queue[i].parents[j] == jobId) {
+                isChild = true;
+                break;
             }
         }
-        struct Process result = queue[highestPriorityIndex];
-        for (int i = highestPriorityIndex; i < queueCount - 1; i++) {
-            queue[i] = queue[i + 1];
+        if (!isChild) {
+            i++;
+            continue;
+        }
+
+        struct Process skipped = queue[i];
+        for (int k = i; k < queueCount - 1; k++) {
+            queue[k] = queue[k + 1];
         }
         queueCount--;
-        printf("Dequeued process: %s (PID: %d)\n", result.executableName, result.pid);
-        return result;
+        recordCompletion(skipped, JOB_SKIPPED);
+        printf("Job %d (%s) skipped: dependency %d did not succeed\n", skipped.jobId, skipped.executableName, jobId);
+
+        skipDependents(skipped.jobId);
+        i = 0;  // The queue was compacted under us, rescan from the start
+    }
+}
+
+// Function to parse "<executable> [priority] [after=<id>,<id>...]".
+// Returns 1 if a priority was given, 0 if not, -1 on a malformed line.
+int parseSubmitLine(char *line, char *name, int *priority, int *parents, int *parentCount) {
+    bool hasPriority = false;
+    *parentCount = 0;
+
+    char *token = strtok(line, " \t");
+    if (token == NULL) return -1;
+    strncpy(name, token, 255);
+    name[255] = '\0';
+
+    while ((token = strtok(NULL, " \t")) != NULL) {
+        if (strncmp(token, "after=", 6) == 0) {
+            // strtok is busy with the outer tokens, so walk the id list by hand
+            char *cursor = token + 6;
+            while (*cursor != '\0') {
+                if (*parentCount >= MAX_DEPENDENCIES) {
+                    printf("Too many dependencies for %s (max %d)\n", name, MAX_DEPENDENCIES);
+                    return -1;
+                }
+                parents[(*parentCount)++] = atoi(cursor);
+                cursor += strcspn(cursor, ",");
+                if (*cursor == ',') cursor++;
+            }
+        } else {
+            *priority = atoi(token);
+            hasPriority = true;
+        }
     }
-    return (struct Process){ .pid = -1 };
+    return hasPriority ? 1 : 0;
 }
 
 // SIGINT handler for starting execution
@@ -97,52 +311,470 @@ void sigintHandler(int signum) {
     executionStarted = true;
 }
 
+// Function to fork a job's process and let it exec once its handler is ready
+void startProcess(struct Process *process) {
+    // Hold SIGUSR1 until the child has its handler installed, or an early
+    // signal kills it and the job is reported as failed
+    sigset_t usr1Mask, oldMask;
+    sigemptyset(&usr1Mask);
+    sigaddset(&usr1Mask, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &usr1Mask, &oldMask);
+    process->pid = fork();
+
+    if (process->pid == 0) {
+        signal(SIGUSR1, sigintHandler);
+        printf("Child Process (PID: %d) waiting for SIGUSR1...\n", getpid());
+        sigset_t waitMask = oldMask;
+        sigdelset(&waitMask, SIGUSR1);
+        sigsuspend(&waitMask);
+        sigset_t emptyMask;
+        sigemptyset(&emptyMask);
+        sigprocmask(SIG_SETMASK, &emptyMask, NULL);
+        execlp(process->executableName, process->executableName, NULL);
+        perror("Failed to execute program");
+        exit(1);
+    }
+
+    sigprocmask(SIG_SETMASK, &oldMask, NULL);
+    printf("Scheduler running: %s (PID: %d)\n", process->executableName, process->pid);
+    kill(process->pid, SIGUSR1);
+    printf("Sent SIGUSR1 to process (PID: %d)\n", process->pid);
+}
+
+// Function to fill a free CPU slot with the next job picked by the policy.
+// Returns false if nothing is ready or admissible.
+bool dispatch(int slot) {
+    struct Process process = dequeue();
+    if (process.jobId == 0) return false;  // Nothing ready, the rest wait on dependencies or memory
+
+    gettimeofday(&process.dispatchTime, NULL);
+    process.isRunning = true;
+    setJobState(process.jobId, JOB_RUNNING);
+
+    if (process.pid == -1) {
+        startProcess(&process);
+    } else {
+        kill(process.pid, SIGCONT);
+        printf("Resumed: %s (PID: %d)\n", process.executableName, process.pid);
+    }
+    running[slot] = process;
+    return true;
+}
+
+// Function to account for a job that exited and settle its dependents
+void finishProcess(struct Process process, int status) {
+    bool succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+    gettimeofday(&process.endTime, NULL);
+    process.runTime += timevalToMs(process.endTime) - timevalToMs(process.dispatchTime);
+    long completionTime = timevalToMs(process.endTime) - timevalToMs(process.startTime);
+    process.waitTime = completionTime - process.runTime;
+    if (completionTime < tslice) completionTime = tslice;
+
+    process.isRunning = false;
+    recordPeakRss(process.executableName, process.peakRss);
+    policy->onExit(&process, succeeded);
+    recordCompletion(process, succeeded ? JOB_DONE : JOB_FAILED);
+    printf("Process %s (PID: %d) completed. Completion Time: %ld ms, Wait Time: %ld ms\n",
+           process.executableName, process.pid, completionTime, process.waitTime);
+
+    // Release dependents right away so they can take the freed slot
+    if (succeeded) {
+        releaseDependents(process.jobId);
+    } else {
+        printf("Job %d (%s) failed, skipping its dependents\n", process.jobId, process.executableName);
+        skipDependents(process.jobId);
+    }
+}
+
 // SIGCHLD handler to reap child processes
 void sigchldHandler(int sig) {
-    while (waitpid(-1, NULL, WNOHANG) > 0);
+    int status;
+    pid_t pid;
+    struct rusage usage;
+    while ((pid = wait4(-1, &status, WNOHANG, &usage)) > 0) {
+        bool found = false;
+        for (int i = 0; i < ncpu; i++) {
+            if (running[i].jobId != 0 && running[i].pid == pid) {
+                struct Process process = running[i];
+                running[i].jobId = 0;
+                process.peakRss = usage.ru_maxrss;
+                finishProcess(process, status);
+                if (executionStarted) fillFreeSlots();
+                found = true;
+                break;
+            }
+        }
+        // A job that was preempted just before exiting is back in the queue
+        for (int i = 0; !found && i < queueCount; i++) {
+            if (queue[i].pid == pid) {
+                struct Process process = queue[i];
+                for (int k = i; k < queueCount - 1; k++) {
+                    queue[k] = queue[k + 1];
+                }
+                queueCount--;
+                process.peakRss = usage.ru_maxrss;
+                finishProcess(process, status);
+                break;
+            }
+        }
+    }
     printf("Child process reaped.\n");
 }
 
-// Scheduler signal handler for process scheduling
+// Scheduler signal handler: throttle for memory, refill the free CPUs, then
+// preempt the expired quanta that a waiting job should replace
 void schedulerSignalHandler(int signum) {
     if (!executionStarted) return;  // Only start if SIGINT received
 
+    // heldBack only records refusals made during this tick
+    for (int i = 0; i < queueCount; i++) {
+        queue[i].heldBack = false;
+    }
+
     struct timeval currentTime;
+    gettimeofday(&currentTime, NULL);
+    for (int i = 0; i < ncpu; i++) {
+        if (running[i].jobId == 0) continue;
+        running[i].runTime += timevalToMs(currentTime) - timevalToMs(running[i].dispatchTime);
+        running[i].dispatchTime = currentTime;
+    }
+
+    throttleForMemory();
+    fillFreeSlots();
+    preemptExpired();
+    fillFreeSlots();
+
+    // Age the jobs admission control refused during this tick
+    for (int i = 0; i < queueCount; i++) {
+        if (!queue[i].heldBack) continue;
+        if (++queue[i].heldTicks == MEMORY_HOLD_TICKS) {
+            printf("Job %d (%s) held back for %d ticks: admitting nothing else ahead of it\n",
+                   queue[i].jobId, queue[i].executableName, MEMORY_HOLD_TICKS);
+        }
+    }
+}
+
+// Function to preempt running jobs only when the policy would rather run a
+// waiting job. The expired jobs compete, as if requeued, with the ready queue;
+// jobs that win keep their slot and simply start a new quantum.
+void preemptExpired() {
+    static struct Process candidates[MAX_PROCESSES + MAX_CPUS];
+    bool expired[MAX_CPUS] = {false};
+    bool keep[MAX_CPUS] = {false};
+    int expiredCount = 0;
+
     for (int i = 0; i < ncpu; i++) {
-        if (queueCount > 0) {
-            struct Process process = dequeue();
-            if (process.pid == -1) continue;
-
-            gettimeofday(&currentTime, NULL);
-            process.waitTime = (currentTime.tv_sec * 1000 + currentTime.tv_usec / 1000) - 
-                               (process.startTime.tv_sec * 1000 + process.startTime.tv_usec / 1000);
-            process.isRunning = true;
-            process.pid = fork();
-
-            if (process.pid == 0) {
-                signal(SIGUSR1, sigintHandler);
-                gettimeofday(&process.startTime, NULL);
-                printf("Child Process (PID: %d) waiting for SIGUSR1...\n", getpid());
-                pause();
-                execlp(process.executableName, process.executableName, NULL);
-                perror("Failed to execute program");
-                exit(1);
-            } else {
-                printf("Scheduler running: %s (PID: %d)\n", process.executableName, process.pid);
-                kill(process.pid, SIGUSR1);
-                printf("Sent SIGUSR1 to process (PID: %d)\n", process.pid);
-                waitpid(process.pid, NULL, 0);
-
-                gettimeofday(&process.endTime, NULL);
-                long completionTime = ((process.endTime.tv_sec * 1000 + process.endTime.tv_usec / 1000) -
-                                       (process.startTime.tv_sec * 1000 + process.startTime.tv_usec / 1000));
-                if (completionTime < tslice) completionTime = tslice;
-
-                completedQueue[completedQueueCount++] = process;
-                printf("Process %s (PID: %d) completed. Completion Time: %ld ms, Wait Time: %ld ms\n",
-                       process.executableName, process.pid, completionTime, process.waitTime);
+        if (running[i].jobId != 0 && policy->onQuantumExpire(&running[i])) {
+            expired[i] = true;
+            expiredCount++;
+        }
+    }
+    if (expiredCount == 0 || queueCount == 0) return;
+
+    int count = 0;
+    for (int i = 0; i < queueCount; i++) {
+        candidates[count++] = queue[i];
+    }
+    for (int i = 0; i < ncpu; i++) {
+        if (!expired[i]) continue;
+        candidates[count] = running[i];
+        policy->onEnqueue(&candidates[count]);
+        count++;
+    }
+
+    // Take as many picks as there are expired slots
+    int queuedPicks = 0;
+    for (int k = 0; k < expiredCount; k++) {
+        int index = pickNext(policy, candidates, count);
+        if (index < 0) break;
+        if (candidates[index].isRunning) {
+            for (int i = 0; i < ncpu; i++) {
+                if (expired[i] && running[i].jobId == candidates[index].jobId) keep[i] = true;
             }
+        } else {
+            queuedPicks++;
         }
+        candidates[index] = candidates[--count];
+    }
+    if (queuedPicks == 0) return;
+
+    for (int i = 0; i < ncpu; i++) {
+        if (expired[i] && !keep[i]) {
+            requeueRunning(i);
+            dispatch(i);
+        }
+    }
+}
+
+// Function to read a small /proc file with open/read, which (unlike stdio)
+// is safe to call from the SIGALRM and SIGCHLD handlers. Returns the number
+// of bytes read, -1 on error; buf is always NUL-terminated.
+ssize_t readProcFile(const char *path, char *buf, size_t size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    ssize_t total = 0, bytes;
+    while (total < (ssize_t)size - 1 && (bytes = read(fd, buf + total, size - 1 - total)) > 0) {
+        total += bytes;
+    }
+    close(fd);
+    buf[total] = '\0';
+    return total;
+}
+
+// Function to parse the number that follows key in text, -1 if absent.
+// Digits are parsed by hand since strtol and sscanf are not async-signal-safe.
+long parseProcField(const char *text, const char *key) {
+    const char *cursor = strstr(text, key);
+    if (cursor == NULL) return -1;
+    cursor += strlen(key);
+    while (*cursor == ' ') cursor++;
+    if (*cursor < '0' || *cursor > '9') return -1;
+
+    long value = 0;
+    while (*cursor >= '0' && *cursor <= '9') {
+        value = value * 10 + (*cursor++ - '0');
+    }
+    return value;
+}
+
+// Function to read MemAvailable from /proc/meminfo, -1 if unavailable
+long readAvailableMemory() {
+    char buf[4096];
+    if (readProcFile("/proc/meminfo", buf, sizeof(buf)) <= 0) return -1;
+    return parseProcField(buf, "MemAvailable:");
+}
+
+// Function to read the PSI "some total" memory stall counter in microseconds,
+// -1 if unavailable. The first total= in the file belongs to the "some" line.
+long readMemoryStallTotal() {
+    char buf[256];
+    if (readProcFile("/proc/pressure/memory", buf, sizeof(buf)) <= 0) return -1;
+    return parseProcField(buf, "total=");
+}
+
+// Function to read a started job's current RSS in KB from /proc/<pid>/statm
+long readCurrentRss(pid_t pid) {
+    // Build "/proc/<pid>/statm" by hand, snprintf is not async-signal-safe
+    char path[32] = "/proc/";
+    char digits[16];
+    int length = strlen(path), digitCount = 0;
+    do {
+        digits[digitCount++] = '0' + pid % 10;
+        pid /= 10;
+    } while (pid > 0);
+    while (digitCount > 0) path[length++] = digits[--digitCount];
+    strcpy(path + length, "/statm");
+
+    char buf[128];
+    if (readProcFile(path, buf, sizeof(buf)) <= 0) return 0;
+    long resident = parseProcField(buf, " ");  // Second field: resident pages
+    return resident > 0 ? resident * pageSizeKb : 0;
+}
+
+// Function to refresh the cached MemAvailable and its low-water mark
+void refreshAvailableMemory() {
+    availableMemory = readAvailableMemory();
+    if (availableMemory >= 0 && (lowestAvailableMemory == -1 || availableMemory < lowestAvailableMemory)) {
+        lowestAvailableMemory = availableMemory;
+    }
+}
+
+// Function to look up the largest peak RSS seen for an executable, 0 if never run
+long predictedFootprint(const char *name) {
+    for (int i = 0; i < memoryEstimateCount; i++) {
+        if (strcmp(memoryEstimates[i].executableName, name) == 0) return memoryEstimates[i].peakRss;
+    }
+    return 0;
+}
+
+// Function to remember an executable's peak RSS for future admission decisions
+void recordPeakRss(const char *name, long peakRss) {
+    for (int i = 0; i < memoryEstimateCount; i++) {
+        if (strcmp(memoryEstimates[i].executableName, name) == 0) {
+            if (peakRss > memoryEstimates[i].peakRss) memoryEstimates[i].peakRss = peakRss;
+            return;
+        }
+    }
+    if (memoryEstimateCount < MAX_PROCESSES) {
+        strncpy(memoryEstimates[memoryEstimateCount].executableName, name,
+                sizeof(memoryEstimates[memoryEstimateCount].executableName) - 1);
+        memoryEstimates[memoryEstimateCount].peakRss = peakRss;
+        memoryEstimateCount++;
+    }
+}
+
+// Function to estimate how much more a started job will allocate before its peak
+long expectedGrowth(const struct Process *process) {
+    long growth = predictedFootprint(process->executableName) - readCurrentRss(process->pid);
+    return growth > 0 ? growth : 0;
+}
+
+// Function to decide whether a job that has not started yet fits in memory.
+// Started jobs (running or stopped) that are still below their predicted peak
+// count against the headroom, so a burst of heavy jobs is not admitted at once.
+bool admitProcess(const struct Process *process) {
+    // Once a job has been held back long enough, nothing new is admitted
+    // ahead of it; the longest-held one goes first, then the lowest job ID
+    for (int i = 0; i < queueCount; i++) {
+        if (queue[i].jobId == process->jobId || queue[i].pid != -1 || queue[i].heldTicks < MEMORY_HOLD_TICKS) continue;
+        if (queue[i].heldTicks > process->heldTicks ||
+            (queue[i].heldTicks == process->heldTicks && queue[i].jobId < process->jobId)) {
+            return false;
+        }
+    }
+
+    long predicted = predictedFootprint(process->executableName);
+    if (predicted == 0 || availableMemory < 0) return true;  // Nothing to go on yet
+
+    int started = 0;
+    long headroom = availableMemory - MEMORY_RESERVE_KB;
+    for (int i = 0; i < ncpu; i++) {
+        if (running[i].jobId == 0) continue;
+        headroom -= expectedGrowth(&running[i]);
+        started++;
+    }
+    for (int i = 0; i < queueCount; i++) {
+        if (queue[i].pid == -1) continue;
+        headroom -= expectedGrowth(&queue[i]);
+        started++;
+    }
+    if (started == 0) return true;  // Never stall with nothing else holding memory
+    return predicted <= headroom;
+}
+
+// Function to SIGSTOP a running job and put it back in the ready queue
+void requeueRunning(int slot) {
+    kill(running[slot].pid, SIGSTOP);
+    running[slot].isRunning = false;
+    setJobState(running[slot].jobId, JOB_PENDING);
+    policy->onEnqueue(&running[slot]);
+    queue[queueCount++] = running[slot];
+    running[slot].jobId = 0;
+}
+
+// Function to adjust the usable CPU slots at most once per pressure window.
+// Pressure is the share of the window spent stalled on memory, from the growth
+// of the PSI "some total" counter. Above MEMORY_PRESSURE_THRESHOLD (or with
+// MemAvailable below the reserve) the limit drops to one less than the jobs
+// running. It only grows back, one at a time, below MEMORY_RECOVER_THRESHOLD
+// (and a quarter above the reserve), so it does not flap. Shrinking stops the jobs with the largest RSS until the
+// running set fits; they stay throttled until the limit recovers or nothing
+// else is running.
+void throttleForMemory() {
+    static long lastSampleMs = -1;
+    static long lastStallTotal = -1;
+
+    // Stopping jobs cannot relieve anything once nothing is running
+    if (runningCount() == 0) releaseThrottled();
+
+    struct timeval currentTime;
+    gettimeofday(&currentTime, NULL);
+    long nowMs = timevalToMs(currentTime);
+    if (lastSampleMs >= 0 && nowMs - lastSampleMs < MEMORY_PRESSURE_WINDOW_MS) return;
+
+    long stallTotal = readMemoryStallTotal();
+    double pressure = -1;
+    if (stallTotal >= 0 && lastStallTotal >= 0 && nowMs > lastSampleMs) {
+        pressure = (stallTotal - lastStallTotal) / 10.0 / (nowMs - lastSampleMs);  // us per ms, as a percentage
+    }
+    lastStallTotal = stallTotal;
+    lastSampleMs = nowMs;
+
+    refreshAvailableMemory();
+    bool underPressure = pressure >= MEMORY_PRESSURE_THRESHOLD ||
+                         (availableMemory >= 0 && availableMemory < MEMORY_RESERVE_KB);
+    bool recovered = pressure < MEMORY_RECOVER_THRESHOLD &&
+                     (availableMemory < 0 || availableMemory >= MEMORY_RESERVE_KB + MEMORY_RESERVE_KB / 4);
+
+    if (underPressure && memorySlots > 1) {
+        // Shrink from the number of jobs actually running, not from an
+        // unused limit, so the first pressure step already stops a job
+        memorySlots = (runningCount() < memorySlots ? runningCount() : memorySlots) - 1;
+        if (memorySlots < 1) memorySlots = 1;
+        printf("Memory pressure (%.2f%% stalled, %ld KB available): limiting to %d running jobs\n",
+               pressure, availableMemory, memorySlots);
+    } else if (recovered) {
+        if (memorySlots < ncpu) {
+            memorySlots++;
+            printf("Memory pressure eased: allowing %d running jobs\n", memorySlots);
+        }
+        releaseThrottled();
+    }
+
+    while (runningCount() > memorySlots) {
+        int largest = -1;
+        long largestRss = -1;
+        for (int i = 0; i < ncpu; i++) {
+            if (running[i].jobId == 0) continue;
+            long rss = readCurrentRss(running[i].pid);
+            if (rss > largestRss) {
+                largest = i;
+                largestRss = rss;
+            }
+        }
+        printf("Throttled: %s (PID: %d, RSS: %ld KB)\n",
+               running[largest].executableName, running[largest].pid, largestRss);
+        requeueRunning(largest);
+        queue[queueCount - 1].throttled = true;
+        throttleStops++;
+    }
+}
+
+// Function to let the throttled job with the smallest RSS run again, so the
+// largest one is released last
+void releaseThrottled() {
+    int smallest = -1;
+    long smallestRss = 0;
+    for (int i = 0; i < queueCount; i++) {
+        if (!queue[i].throttled) continue;
+        long rss = readCurrentRss(queue[i].pid);
+        if (smallest == -1 || rss < smallestRss) {
+            smallest = i;
+            smallestRss = rss;
+        }
+    }
+    if (smallest == -1) return;
+
+    queue[smallest].throttled = false;
+    printf("Released: %s (PID: %d, RSS: %ld KB)\n",
+           queue[smallest].executableName, queue[smallest].pid, smallestRss);
+}
+
+// Function to fill free CPU slots, up to the memory limit, with admitted jobs
+void fillFreeSlots() {
+    if (runningCount() >= memorySlots) return;
+
+    refreshAvailableMemory();
+    for (int i = 0; i < queueCount; i++) {
+        queue[i].heldBack = false;
+    }
+
+    for (int i = 0; i < ncpu && runningCount() < memorySlots; i++) {
+        if (running[i].jobId == 0 && !dispatch(i)) break;
+    }
+
+    for (int i = 0; i < queueCount; i++) {
+        if (queue[i].heldBack && !everHeldBack[JOB_SLOT(queue[i].jobId)]) {
+            everHeldBack[JOB_SLOT(queue[i].jobId)] = true;
+            admissionHolds++;
+            printf("Held back: %s (Job ID: %d) needs ~%ld KB, %ld KB available\n", queue[i].executableName,
+                   queue[i].jobId, predictedFootprint(queue[i].executableName), availableMemory);
+        }
+    }
+}
+
+// Function to print the admission and throttling decisions
+void printMemoryStats() {
+    printf("\n---- Memory Admission ----\n");
+    printf("Jobs Held Back: %d\n", admissionHolds);
+    printf("Throttle Stops: %d\n", throttleStops);
+    if (lowestAvailableMemory >= 0) {
+        printf("Lowest MemAvailable: %ld KB\n", lowestAvailableMemory);
+    }
+    for (int i = 0; i < memoryEstimateCount; i++) {
+        printf("Peak RSS of %s: %ld KB\n", memoryEstimates[i].executableName, memoryEstimates[i].peakRss);
     }
 }
 
@@ -151,15 +783,149 @@ void printProcessCompletionDetails() {
     printf("\n---- Process Completion Details ----\n");
     for (int i = 0; i < completedQueueCount; i++) {
         struct Process process = completedQueue[i];
-        long completionTime = ((process.endTime.tv_sec * 1000 + process.endTime.tv_usec / 1000) -
-                               (process.startTime.tv_sec * 1000 + process.startTime.tv_usec / 1000));
+        long completionTime = timevalToMs(process.endTime) - timevalToMs(process.startTime);
         if (completionTime < tslice) completionTime = tslice;
 
-        printf("Process: %s (PID: %d)\n", process.executableName, process.pid);
+        printf("Process: %s (PID: %d, Job ID: %d)\n", process.executableName, process.pid, process.jobId);
+        if (process.parentCount > 0) {
+            printf("Depends On:");
+            for (int j = 0; j < process.parentCount; j++) {
+                printf(" %d", process.parents[j]);
+            }
+            printf("\n");
+        }
+        if (process.state == JOB_SKIPPED) {
+            printf("Status: skipped (dependency failed)\n");
+            printf("---------------------------------\n");
+            continue;
+        }
+        printf("Status: %s\n", process.state == JOB_FAILED ? "failed" : "completed");
         printf("Completion Time: %ld ms\n", completionTime);
         printf("Wait Time: %ld ms\n", process.waitTime);
+        printf("Run Time: %ld ms\n", process.runTime);
+        printf("Peak RSS: %ld KB\n", process.peakRss);
         printf("---------------------------------\n");
     }
+    if (unreportedCount > 0) {
+        printf("Details and summary cover the first %d jobs; %d later jobs are not shown.\n", MAX_JOBS, unreportedCount);
+    }
+    printScheduleSummary(completedQueue, completedQueueCount);
+    printMemoryStats();
+}
+
+// Function to record the jobs that ran as a schedsim trace:
+// "<name> <arrival_ms> <burst_ms> <priority>", arrivals relative to the first job
+void writeTrace(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        perror("fopen");
+        return;
+    }
+
+    long firstArrival = -1;
+    for (int i = 0; i < completedQueueCount; i++) {
+        long arrivalMs = timevalToMs(completedQueue[i].startTime);
+        if (completedQueue[i].pid != -1 && (firstArrival == -1 || arrivalMs < firstArrival)) {
+            firstArrival = arrivalMs;
+        }
+    }
+    for (int i = 0; i < completedQueueCount; i++) {
+        struct Process process = completedQueue[i];
+        if (process.pid == -1) continue;  // Skipped, never ran
+        long burstMs = process.runTime > 0 ? process.runTime : 1;  // Sub-millisecond runs round down to 0
+        fprintf(file, "%s %ld %ld %d\n", process.executableName,
+                timevalToMs(process.startTime) - firstArrival, burstMs, process.priority);
+    }
+    fclose(file);
+    printf("Trace written to %s\n", path);
+}
+
+// Function to submit every job in a DAG file. Each job line uses the submit
+// syntax, and after=<n> refers to the n-th job line of the same file (1-based;
+// comments and blank lines are not counted). Relative executable paths are
+// resolved against the file's directory.
+void submitDagFile(SharedMemoryData *sharedData, const char *path) {
+    // One entry per job line, parsed and validated before anything is queued
+    static char names[MAX_PROCESSES][256];
+    static int priorities[MAX_PROCESSES];
+    static int fileParents[MAX_PROCESSES][MAX_DEPENDENCIES];
+    static int fileParentCounts[MAX_PROCESSES];
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror("fopen");
+        return;
+    }
+
+    const char *slash = strrchr(path, '/');
+    int dirLength = slash == NULL ? -1 : (int)(slash - path);
+
+    int fileJobCount = 0;
+    bool valid = true;
+    char line[1024];
+    while (valid && fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[strspn(line, " \t")] == '\0' || line[strspn(line, " \t")] == '#') continue;
+
+        if (fileJobCount >= MAX_PROCESSES) {
+            printf("DAG file %s has too many jobs (max %d)\n", path, MAX_PROCESSES);
+            valid = false;
+            break;
+        }
+        int job = fileJobCount;
+        priorities[job] = 1;
+        if (parseSubmitLine(line, names[job], &priorities[job], fileParents[job], &fileParentCounts[job]) < 0) {
+            valid = false;
+            break;
+        }
+        if (dirLength >= 0 && names[job][0] != '/' && strchr(names[job], '/') != NULL) {
+            char resolved[sizeof(names[job])];
+            if (snprintf(resolved, sizeof(resolved), "%.*s/%s", dirLength, path, names[job]) >= (int)sizeof(resolved)) {
+                printf("DAG file %s: path of %s is too long\n", path, names[job]);
+                valid = false;
+                break;
+            }
+            strcpy(names[job], resolved);
+        }
+        for (int i = 0; i < fileParentCounts[job]; i++) {
+            if (fileParents[job][i] < 1 || fileParents[job][i] > job) {
+                printf("DAG file %s: %s depends on unknown line %d\n", path, names[job], fileParents[job][i]);
+                valid = false;
+                break;
+            }
+        }
+        fileJobCount++;
+    }
+    fclose(file);
+
+    if (valid && queueCount + runningCount() + fileJobCount > MAX_PROCESSES) {
+        printf("Queue is full. Cannot add %d jobs from DAG file %s\n", fileJobCount, path);
+        valid = false;
+    }
+    for (int job = 0; valid && job < fileJobCount; job++) {
+        if (!jobSlotFree(nextJobId + job)) {
+            printf("Too many jobs in flight: job %d has not finished and job slots are reused every %d jobs. "
+                   "Cannot add %d jobs from DAG file %s\n", nextJobId + job - MAX_JOBS, MAX_JOBS, fileJobCount, path);
+            valid = false;
+        }
+    }
+    if (!valid) {
+        printf("DAG file %s rejected, no jobs submitted\n", path);
+        return;
+    }
+
+    // File lines map to consecutive job IDs, so after=<n> becomes firstId + n - 1
+    int firstId = nextJobId;
+    int submitted = 0;
+    for (int job = 0; job < fileJobCount; job++) {
+        for (int i = 0; i < fileParentCounts[job]; i++) {
+            fileParents[job][i] += firstId - 1;
+        }
+        if (enqueue(sharedData, names[job], priorities[job], fileParents[job], fileParentCounts[job]) != 0) {
+            submitted++;
+        }
+    }
+    printf("Submitted %d jobs from DAG file %s\n", submitted, path);
 }
 
 // Function to initialize shared memory
@@ -186,18 +952,43 @@ int main(int argc, char *argv[]) {
     // printf("Starting SimpleScheduler with %d CPU cores and a time slice of %d milliseconds.\n", ncpu, tslice);
     SharedMemoryData *sharedData = NULL;
 
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <NCPU> <TSLICE>\n", argv[0]);
+    if (argc != 3 && argc != 4) {
+        fprintf(stderr, "Usage: %s <NCPU> <TSLICE> [POLICY]\n", argv[0]);
         return 1;
     }
 
     ncpu = atoi(argv[1]);
     tslice = atoi(argv[2]);
-    printf("Starting SimpleScheduler with %d CPU cores and a time slice of %d milliseconds.\n", ncpu, tslice);
+    if (ncpu < 1 || ncpu > MAX_CPUS) {
+        fprintf(stderr, "NCPU must be between 1 and %d\n", MAX_CPUS);
+        return 1;
+    }
+    memorySlots = ncpu;
+    pageSizeKb = sysconf(_SC_PAGESIZE) / 1024;
+    policy = findPolicy(argc == 4 ? argv[3] : "priority");
+    if (policy == NULL) {
+        fprintf(stderr, "Unknown policy %s. Available: ", argv[3]);
+        printPolicyNames();
+        return 1;
+    }
+    printf("Starting SimpleScheduler with %d CPU cores and a time slice of %d milliseconds (policy: %s).\n",
+           ncpu, tslice, policy->name);
     init_shared_memory(&sharedData);
 
-    signal(SIGALRM, schedulerSignalHandler);
-    signal(SIGCHLD, sigchldHandler);
+    // The tick and the reaper both edit the queue and CPU slots, so each masks the other
+    sigset_t schedulerSignals;
+    sigemptyset(&schedulerSignals);
+    sigaddset(&schedulerSignals, SIGALRM);
+    sigaddset(&schedulerSignals, SIGCHLD);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_mask = schedulerSignals;
+    action.sa_flags = SA_RESTART;
+    action.sa_handler = schedulerSignalHandler;
+    sigaction(SIGALRM, &action, NULL);
+    action.sa_handler = sigchldHandler;
+    sigaction(SIGCHLD, &action, NULL);
     signal(SIGINT, sigintHandler);  // Register SIGINT handler
 
     struct itimerval timer;
@@ -207,18 +998,54 @@ int main(int argc, char *argv[]) {
     timer.it_interval.tv_usec = tslice * 1000;
     setitimer(ITIMER_REAL, &timer, NULL);
 
+    char line[1024];
     char executableName[256];
     int priority;
+    int parents[MAX_DEPENDENCIES];
+    int parentCount;
+
+    // Input: "<executable> [priority] [after=<id>,<id>]", "dag <file>" or "exit".
+    // A bare "dag" is a usage error; run an executable named dag or exit as ./dag or ./exit.
+    // The priority is only prompted for on a terminal; piped input defaults to 1.
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[strspn(line, " \t")] == '\0') continue;
+        if (strcmp(line, "exit") == 0) break;
+        sigset_t oldMask;
+        if (strcmp(line, "dag") == 0) {
+            printf("Usage: dag <file>\n");
+            continue;
+        }
+        if (strncmp(line, "dag ", 4) == 0) {
+            sigprocmask(SIG_BLOCK, &schedulerSignals, &oldMask);
+            submitDagFile(sharedData, line + 4 + strspn(line + 4, " \t"));
+            sigprocmask(SIG_SETMASK, &oldMask, NULL);
+            continue;
+        }
 
-    while (true) {
-        if (scanf("%s", executableName) != 1 || strcmp(executableName, "exit") == 0) break;
+        priority = 1;
+        int parsed = parseSubmitLine(line, executableName, &priority, parents, &parentCount);
+        if (parsed < 0) continue;
+        if (parsed == 0 && isatty(STDIN_FILENO)) {
+            printf("Enter priority for %s: ", executableName);
+            if (fgets(line, sizeof(line), stdin) == NULL) break;
+            priority = atoi(line);
+        }
+        sigprocmask(SIG_BLOCK, &schedulerSignals, &oldMask);
+        enqueue(sharedData, executableName, priority, parents, parentCount);
+        sigprocmask(SIG_SETMASK, &oldMask, NULL);
+    }
 
-        printf("Enter priority for %s: ", executableName);
-        scanf("%d", &priority);
-        enqueue(sharedData, executableName, priority);
+    // Jobs run in the background now, so let the started ones drain before reporting
+    sigset_t waitMask;
+    sigprocmask(SIG_BLOCK, &schedulerSignals, &waitMask);
+    while (executionStarted && (queueCount > 0 || runningCount() > 0)) {
+        sigsuspend(&waitMask);
     }
+    sigprocmask(SIG_SETMASK, &waitMask, NULL);
 
     printProcessCompletionDetails();
+    if (getenv("SCHED_TRACE") != NULL) writeTrace(getenv("SCHED_TRACE"));
     munmap(sharedData, sizeof(SharedMemoryData));
     shm_unlink(SHARED_MEM_NAME);
 
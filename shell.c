@@ -10,6 +10,7 @@
 #include <signal.h>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <limits.h>
 #include "shared_memory.h"
 
 /* Constants */
@@ -32,6 +33,7 @@ pid_t *pids;
 time_t *start_times;
 double *durations;
 volatile sig_atomic_t exit_shell = 0; // Flag for SIGINT
+int scheduler_fd = -1; // Write end of the scheduler's stdin
 
 /* Function declarations */
 void init_history();
@@ -44,6 +46,7 @@ void execute_piped_commands(char *cmd_parts[], int num_parts);
 int is_blank(char *input);
 int handle_builtin(char *input);
 void enqueue_for_scheduler(const char *cmd, int priority);
+int forward_to_scheduler(const char *line);
 void handle_scheduler_signal(int signo);
 void execute_shared_memory_command(); 
 void handle_sigint(int signo); // SIGINT handler
@@ -197,6 +200,16 @@ void enqueue_for_scheduler(const char *cmd, int priority) {
     close(shm_fd);
 }
 
+/* Pass a submit line to the scheduler, which parses priority, after= and dag. Returns 0 on success, -1 on error */
+int forward_to_scheduler(const char *line) {
+    size_t len = strlen(line);
+    if (scheduler_fd == -1 || write(scheduler_fd, line, len) != (ssize_t)len || write(scheduler_fd, "\n", 1) != 1) {
+        perror("scheduler");
+        return -1;
+    }
+    return 0;
+}
+
 void execute_single_command(char *cmd) {
     char *args[ARG_MAX_COUNT];
     int tokenCount = 0;
@@ -204,8 +217,50 @@ void execute_single_command(char *cmd) {
 
     // Handle "submit" commands
     if (strncmp(cmd, "submit ", 7) == 0) {
-        char *program = cmd + 7;  // Skip the "submit " part
-        
+        char *program = cmd + 7 + strspn(cmd + 7, " ");  // Skip the "submit " part
+        size_t name_len = strcspn(program, " \t");
+        char resolved[PATH_MAX];
+        char forwarded[PATH_MAX + ARG_MAX_COUNT];
+
+        if (name_len == 0) {
+            fprintf(stderr, "Usage: submit <executable> [priority] [after=<id>,<id>...]\n");
+            return;
+        }
+        // "exit" and "dag" are control lines to the scheduler, not executables
+        if (name_len == 4 && strncmp(program, "exit", 4) == 0) {
+            fprintf(stderr, "submit: exit is reserved, use ./exit to run a program named exit\n");
+            return;
+        }
+        if (name_len == 3 && strncmp(program, "dag", 3) == 0) {
+            char *file = program + 3 + strspn(program + 3, " \t");
+            if (*file == '\0') {
+                fprintf(stderr, "Usage: submit dag <file>\n");
+                return;
+            }
+            // The scheduler has its own cwd, so send an absolute path
+            if (realpath(file, resolved) == NULL) {
+                perror(file);
+                return;
+            }
+            snprintf(forwarded, sizeof(forwarded), "dag %s", resolved);
+            forward_to_scheduler(forwarded);
+            return;
+        }
+
+        // Same for a relative executable path; bare names are looked up in PATH
+        char name[PATH_MAX];
+        snprintf(name, sizeof(name), "%.*s", (int)name_len, program);
+        if (name[0] != '/' && strchr(name, '/') != NULL) {
+            if (realpath(name, resolved) == NULL) {
+                perror(name);
+                return;
+            }
+            snprintf(name, sizeof(name), "%s", resolved);
+        }
+        snprintf(forwarded, sizeof(forwarded), "%s%s", name, program + name_len);
+        if (forward_to_scheduler(forwarded) != 0) return;
+        program = forwarded;
+
         // Split the command into arguments
         char *token = strtok(program, " ");
         while (token != NULL && tokenCount < ARG_MAX_COUNT) {
@@ -217,7 +272,10 @@ void execute_single_command(char *cmd) {
         // The first argument after "submit" should be the program/executable name
         if (tokenCount > 0) {
             char *executable = args[0];
-            int priority = (tokenCount > 1) ? atoi(args[1]) : 1; // Optional priority value, defaults to 1
+            int priority = 1; // Optional priority value, defaults to 1
+            for (int i = 1; i < tokenCount; i++) {
+                if (strncmp(args[i], "after=", 6) != 0) priority = atoi(args[i]);
+            }
 
             // Enqueue the command for the scheduler
             enqueue_for_scheduler(executable, priority);
@@ -335,15 +393,28 @@ int main(int argc, char *argv[]) {
     int tslice = atoi(argv[2]);
 
 
+    // Submit lines reach the scheduler through a pipe on its stdin
+    int scheduler_pipe[2];
+    if (pipe(scheduler_pipe) == -1) {
+        perror("pipe");
+        exit(EXIT_FAILURE);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
     int scheduler_pid = fork();
     if (scheduler_pid == 0) {
-
+        dup2(scheduler_pipe[0], STDIN_FILENO);
+        close(scheduler_pipe[0]);
+        close(scheduler_pipe[1]);
 
         execl("./scheduler", "./scheduler", argv[1], argv[2], NULL);
         perror("Scheduler exec failed");
         exit(EXIT_FAILURE);
     }
 
+    close(scheduler_pipe[0]);
+    scheduler_fd = scheduler_pipe[1];
+
     printf("Starting SimpleShell with %d CPU cores and a time slice of %d milliseconds.\n", ncpu, tslice);
 
 
@@ -363,6 +434,7 @@ int main(int argc, char *argv[]) {
         if (is_blank(input)) continue;
         int result = handle_builtin(input);
         if (result == -1) break;
+        if (result == 0) continue; // Built-in handled, nothing to execute
 
    
         execute_single_command(input);
@@ -371,6 +443,10 @@ int main(int argc, char *argv[]) {
     }
 
 
+    // EOF tells the scheduler to finish its started jobs and print its report
+    close(scheduler_fd);
+    waitpid(scheduler_pid, NULL, 0);
+
     for (int i = 0; i < history_len; i++) free(history[i]);
     free(history);
     free(pids);